@@ -8,8 +8,6 @@
 #define FONTSET_SIZE 80
 #define ROM_START 0x200
 #define CACHE_SIZE 256
-#define DEFAULT_SCALE 10
-#define TARGET_FPS 60
 
 static const unsigned char fontset[FONTSET_SIZE] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -39,15 +37,17 @@ typedef struct {
 
 static MemoryCache sprite_cache;
 
-static void initialize_sdl(Emu8* emu8) {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0) {
+// Video also brings up events; timers are driven by the frame loop
+void init_sdl(void) {
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         fprintf(stderr, "[%s] SDL initialization failed: %s\n", 
                 __TIME__, SDL_GetError());
         exit(1);
     }
 }
 
-void create_window_and_renderer(Emu8* emu8, int scale, int fullscreen) {
+// Returns 1 if presents are synced to vblank, which drivers may refuse
+int create_window_and_renderer(Emu8* emu8, int scale, int fullscreen, int vsync) {
     Uint32 window_flags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE;
     if (fullscreen) window_flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
 
@@ -62,8 +62,10 @@ void create_window_and_renderer(Emu8* emu8, int scale, int fullscreen) {
         exit(1);
     }
 
-    emu8->renderer = SDL_CreateRenderer(emu8->window, -1, 
-                                       SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
+    Uint32 renderer_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+    if (vsync) renderer_flags |= SDL_RENDERER_PRESENTVSYNC;
+
+    emu8->renderer = SDL_CreateRenderer(emu8->window, -1, renderer_flags);
     if (!emu8->renderer) {
         fprintf(stderr, "[%s] Renderer creation failed: %s\n", 
                 __TIME__, SDL_GetError());
@@ -86,11 +88,14 @@ void create_window_and_renderer(Emu8* emu8, int scale, int fullscreen) {
     }
 
     SDL_RenderSetLogicalSize(emu8->renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
-}
 
-static void handle_interrupts(Emu8* emu8, Uint32 interval, void* data) {
-    if (emu8->delay_timer > 0) emu8->delay_timer--;
-    if (emu8->sound_timer > 0) emu8->sound_timer--;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(emu8->renderer, &info) < 0) {
+        fprintf(stderr, "[%s] Renderer info query failed: %s\n", 
+                __TIME__, SDL_GetError());
+        return 0;
+    }
+    return (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
 }
 
 void init_emu8(Emu8* emu8) {
@@ -102,19 +107,9 @@ void init_emu8(Emu8* emu8) {
     // Initialize keypad
     keypad_init(&emu8->keypad); // Added
 
-    initialize_sdl(emu8);
-
     sprite_cache.address = 0;
     sprite_cache.size = 0;
     sprite_cache.last_access = time(NULL);
-
-    create_window_and_renderer(emu8, DEFAULT_SCALE, 0);
-
-    emu8->timer_id = SDL_AddTimer(1000 / TARGET_FPS, handle_interrupts, emu8);
-    if (emu8->timer_id == 0) {
-        fprintf(stderr, "[%s] Timer setup failed: %s\n", 
-                __TIME__, SDL_GetError());
-    }
 }
 
 void load_rom(Emu8* emu8, const char* filename) {
@@ -124,20 +119,28 @@ void load_rom(Emu8* emu8, const char* filename) {
         exit(1);
     }
 
-    fseek(rom, 0, SEEK_END);
-    long rom_size = ftell(rom);
-    rewind(rom);
+    // One read straight into memory; any byte left over means the ROM does not fit
+    size_t rom_size = fread(&emu8->memory[ROM_START], 1, MEMORY_SIZE - ROM_START, rom);
 
-    if (rom_size > MEMORY_SIZE - ROM_START) {
-        fprintf(stderr, "[%s] ROM too large: %ld bytes (max %d bytes)\n", 
-                __TIME__, rom_size, MEMORY_SIZE - ROM_START);
+    if (ferror(rom)) {
+        fprintf(stderr, "[%s] Failed to read ROM file: %s\n", __TIME__, filename);
+        fclose(rom);
+        exit(1);
+    }
+    if (rom_size == 0) {
+        fprintf(stderr, "[%s] ROM file is empty: %s\n", __TIME__, filename);
+        fclose(rom);
+        exit(1);
+    }
+    if (fgetc(rom) != EOF) {
+        fprintf(stderr, "[%s] ROM too large: more than %d bytes\n", 
+                __TIME__, MEMORY_SIZE - ROM_START);
         fclose(rom);
         exit(1);
     }
 
-    size_t bytes_read = fread(&emu8->memory[ROM_START], 1, rom_size, rom);
     printf("[%s] Loaded %zu bytes from ROM, PC still at 0x%04X\n", 
-           __TIME__, bytes_read, emu8->pc);
+           __TIME__, rom_size, emu8->pc);
 
     if (rom_size < CACHE_SIZE) {
         memcpy(sprite_cache.data, &emu8->memory[ROM_START], rom_size);
@@ -167,7 +170,6 @@ unsigned char* get_cached_memory(Emu8* emu8, unsigned short address, size_t size
 }
 
 void cleanup_emu8(Emu8* emu8) {
-    if (emu8->timer_id) SDL_RemoveTimer(emu8->timer_id);
     if (emu8->texture) SDL_DestroyTexture(emu8->texture);
     if (emu8->renderer) SDL_DestroyRenderer(emu8->renderer);
     if (emu8->window) SDL_DestroyWindow(emu8->window);
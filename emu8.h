@@ -24,13 +24,13 @@ typedef struct {
     SDL_Window* window;                 // SDL window
     SDL_Renderer* renderer;             // SDL renderer
     SDL_Texture* texture;               // SDL texture for caching
-    SDL_TimerID timer_id;               // Timer ID for interrupts
 } Emu8;
 
 void init_emu8(Emu8* emu8);
+void init_sdl(void);
 void load_rom(Emu8* emu8, const char* filename);
 unsigned char* get_cached_memory(Emu8* emu8, unsigned short address, size_t size);
 void cleanup_emu8(Emu8* emu8);
-void create_window_and_renderer(Emu8* emu8, int scale, int fullscreen); // Added declaration
+int create_window_and_renderer(Emu8* emu8, int scale, int fullscreen, int vsync); // Returns 1 if vsync was granted
 
 #endif
\ No newline at end of file
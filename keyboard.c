@@ -1,56 +1,122 @@
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include "keyboard.h"
 
+// COSMAC VIP layout mapped onto the left side of a QWERTY keyboard
+static const SDL_Keycode default_keymap[KEYPAD_SIZE] = {
+    SDLK_x, SDLK_1, SDLK_2, SDLK_3, // 0-3
+    SDLK_q, SDLK_w, SDLK_e, SDLK_a, // 4-7
+    SDLK_s, SDLK_d, SDLK_z, SDLK_c, // 8-B
+    SDLK_4, SDLK_r, SDLK_f, SDLK_v  // C-F
+};
+
 void keypad_init(Keypad* keypad) {
+    memset(keypad, 0, sizeof(Keypad));
+    memcpy(keypad->keymap, default_keymap, sizeof(default_keymap));
+    keypad->waiting_key = -1;
+}
+
+int keypad_set_keymap(Keypad* keypad, const char* layout) {
+    if (strlen(layout) != KEYPAD_SIZE) return -1;
+
+    // Printable SDL keycodes are their lowercase ASCII characters
+    SDL_Keycode keymap[KEYPAD_SIZE];
+    for (int i = 0; i < KEYPAD_SIZE; i++) {
+        if (!isprint((unsigned char)layout[i])) return -1;
+        keymap[i] = (SDL_Keycode)tolower((unsigned char)layout[i]);
+        for (int j = 0; j < i; j++) {
+            if (keymap[j] == keymap[i]) return -1; // Would leave a CHIP-8 key unreachable
+        }
+    }
+    memcpy(keypad->keymap, keymap, sizeof(keymap));
+    return 0;
+}
+
+int keypad_map_key(const Keypad* keypad, SDL_Keycode sym) {
     for (int i = 0; i < KEYPAD_SIZE; i++) {
-        keypad->keys[i] = 0;
+        if (keypad->keymap[i] == sym) return i;
+    }
+    return -1;
+}
+
+static void key_queue_push(KeyQueue* queue, const KeyEvent* event) {
+    unsigned int head = (unsigned int)SDL_AtomicGet(&queue->head);
+    unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+    if (head - tail >= KEY_QUEUE_SIZE) {
+        fprintf(stderr, "[%s] Key queue full, dropping event\n", __TIME__);
+        return;
+    }
+
+    queue->events[head & (KEY_QUEUE_SIZE - 1)] = *event;
+    SDL_MemoryBarrierRelease(); // Slot contents must be visible before the new head
+    SDL_AtomicSet(&queue->head, (int)(head + 1));
+}
+
+static const KeyEvent* key_queue_peek(KeyQueue* queue) {
+    unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+    if (tail == (unsigned int)SDL_AtomicGet(&queue->head)) return NULL;
+    SDL_MemoryBarrierAcquire();
+    return &queue->events[tail & (KEY_QUEUE_SIZE - 1)];
+}
+
+static void key_queue_pop(KeyQueue* queue) {
+    unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+    SDL_MemoryBarrierRelease(); // Done reading the slot before handing it back
+    SDL_AtomicSet(&queue->tail, (int)(tail + 1));
+}
+
+// Runs inside SDL_PumpEvents, which the pacer calls every millisecond while it sleeps,
+// so most events are stamped as they arrive. Events landing while nothing pumps are
+// stamped at the next SDL_PollEvent instead. In emulated mode that is the 2 ms spin
+// before the deadline, plus the instruction batch and render. In display mode it is
+// the present budget: 4 ms, widened to at most 3/4 of a refresh after missed vblanks.
+static int keypad_event_watch(void* data, SDL_Event* event) {
+    Keypad* keypad = (Keypad*)data;
+    if (event->type != SDL_KEYDOWN && event->type != SDL_KEYUP) return 0;
+    if (event->key.repeat) return 0;
+
+    int key = keypad_map_key(keypad, event->key.keysym.sym);
+    if (key < 0) return 0;
+
+    KeyEvent key_event;
+    key_event.timestamp = pacer_now_ns();
+    key_event.key = (unsigned char)key;
+    key_event.pressed = event->type == SDL_KEYDOWN;
+    key_queue_push(&keypad->queue, &key_event);
+    return 0;
+}
+
+void keypad_attach(Keypad* keypad) {
+    SDL_AddEventWatch(keypad_event_watch, keypad);
+}
+
+void keypad_detach(Keypad* keypad) {
+    SDL_DelEventWatch(keypad_event_watch, keypad);
+}
+
+void keypad_apply_events(Keypad* keypad, Uint64 until) {
+    unsigned short pressed_now = 0; // Keys pressed by this call
+    const KeyEvent* event;
+    while ((event = key_queue_peek(&keypad->queue)) && event->timestamp <= until) {
+        // Leave a same-slice release for the next instruction so short taps are still seen
+        if (!event->pressed && (pressed_now & (1 << event->key))) break;
+        if (event->pressed) pressed_now |= 1 << event->key;
+
+        keypad->keys[event->key] = event->pressed;
+        if (event->pressed && keypad->unpresented_count < KEY_QUEUE_SIZE) {
+            keypad->unpresented[keypad->unpresented_count++] = event->timestamp;
+        }
+        key_queue_pop(&keypad->queue);
     }
 }
 
-void keypad_handle_event(Keypad* keypad, SDL_Event* event, int* running) {
-    switch (event->type) {
-        case SDL_KEYDOWN:
-            switch (event->key.keysym.sym) {
-                case SDLK_1: keypad->keys[0x1] = 1; break;
-                case SDLK_2: keypad->keys[0x2] = 1; break;
-                case SDLK_3: keypad->keys[0x3] = 1; break;
-                case SDLK_4: keypad->keys[0xC] = 1; break;
-                case SDLK_q: keypad->keys[0x4] = 1; break;
-                case SDLK_w: keypad->keys[0x5] = 1; break;
-                case SDLK_e: keypad->keys[0x6] = 1; break;
-                case SDLK_r: keypad->keys[0xD] = 1; break;
-                case SDLK_a: keypad->keys[0x7] = 1; break;
-                case SDLK_s: keypad->keys[0x8] = 1; break;
-                case SDLK_d: keypad->keys[0x9] = 1; break;
-                case SDLK_f: keypad->keys[0xE] = 1; break;
-                case SDLK_z: keypad->keys[0xA] = 1; break;
-                case SDLK_x: keypad->keys[0x0] = 1; break;
-                case SDLK_c: keypad->keys[0xB] = 1; break;
-                case SDLK_v: keypad->keys[0xF] = 1; break;
-                case SDLK_ESCAPE: *running = 0; break;
-            }
-            break;
-        case SDL_KEYUP:
-            switch (event->key.keysym.sym) {
-                case SDLK_1: keypad->keys[0x1] = 0; break;
-                case SDLK_2: keypad->keys[0x2] = 0; break;
-                case SDLK_3: keypad->keys[0x3] = 0; break;
-                case SDLK_4: keypad->keys[0xC] = 0; break;
-                case SDLK_q: keypad->keys[0x4] = 0; break;
-                case SDLK_w: keypad->keys[0x5] = 0; break;
-                case SDLK_e: keypad->keys[0x6] = 0; break;
-                case SDLK_r: keypad->keys[0xD] = 0; break;
-                case SDLK_a: keypad->keys[0x7] = 0; break;
-                case SDLK_s: keypad->keys[0x8] = 0; break;
-                case SDLK_d: keypad->keys[0x9] = 0; break;
-                case SDLK_f: keypad->keys[0xE] = 0; break;
-                case SDLK_z: keypad->keys[0xA] = 0; break;
-                case SDLK_x: keypad->keys[0x0] = 0; break;
-                case SDLK_c: keypad->keys[0xB] = 0; break;
-                case SDLK_v: keypad->keys[0xF] = 0; break;
-            }
-            break;
+// Input-to-photon probe: time from key press arrival to the present that followed it
+void keypad_record_latency(Keypad* keypad, TimingStats* stats, Uint64 presented) {
+    for (int i = 0; i < keypad->unpresented_count; i++) {
+        timing_stats_record(stats, presented - keypad->unpresented[i]);
     }
+    keypad->unpresented_count = 0;
 }
 
 int keypad_get_pressed_key(Keypad* keypad) {
@@ -60,4 +126,17 @@ int keypad_get_pressed_key(Keypad* keypad) {
         }
     }
     return -1; // No key pressed
-}
\ No newline at end of file
+}
+
+int keypad_get_released_key(Keypad* keypad) {
+    if (keypad->waiting_key < 0) {
+        keypad->waiting_key = keypad_get_pressed_key(keypad);
+        return -1;
+    }
+
+    if (keypad->keys[keypad->waiting_key]) return -1; // Still held
+
+    int key = keypad->waiting_key;
+    keypad->waiting_key = -1;
+    return key;
+}
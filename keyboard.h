@@ -2,15 +2,41 @@
 #define KEYBOARD_H
 
 #include <SDL2/SDL.h>
+#include "pacer.h"
 
 #define KEYPAD_SIZE 16
+#define KEY_QUEUE_SIZE 256 // Must be a power of two
 
 typedef struct {
-    unsigned char keys[KEYPAD_SIZE]; // 0-F key states (0 = released, 1 = pressed)
+    Uint64 timestamp;       // Host arrival time in nanoseconds (pacer_now_ns)
+    unsigned char key;      // CHIP-8 key (0-F)
+    unsigned char pressed;  // 1 = pressed, 0 = released
+} KeyEvent;
+
+// Single-producer/single-consumer ring: the SDL event watch pushes, the CPU loop pops
+typedef struct {
+    KeyEvent events[KEY_QUEUE_SIZE];
+    SDL_atomic_t head;      // Next slot to write, only advanced by the producer
+    SDL_atomic_t tail;      // Next slot to read, only advanced by the consumer
+} KeyQueue;
+
+typedef struct {
+    unsigned char keys[KEYPAD_SIZE];     // 0-F key states (0 = released, 1 = pressed)
+    SDL_Keycode keymap[KEYPAD_SIZE];     // Host key bound to each CHIP-8 key
+    int waiting_key;                     // FX0A: key held while waiting for release, -1 if none
+    KeyQueue queue;                      // Timestamped events not yet applied
+    Uint64 unpresented[KEY_QUEUE_SIZE];  // Applied key presses not yet presented
+    int unpresented_count;
 } Keypad;
 
 void keypad_init(Keypad* keypad);
-void keypad_handle_event(Keypad* keypad, SDL_Event* event, int* running);
+int keypad_set_keymap(Keypad* keypad, const char* layout); // 16 keys for 0-F, returns -1 if invalid
+int keypad_map_key(const Keypad* keypad, SDL_Keycode sym); // Returns the CHIP-8 key (0-F) or -1
+void keypad_attach(Keypad* keypad); // Start timestamping key events as SDL receives them
+void keypad_detach(Keypad* keypad);
+void keypad_apply_events(Keypad* keypad, Uint64 until); // Apply queued events up to a host time
+void keypad_record_latency(Keypad* keypad, TimingStats* stats, Uint64 presented);
 int keypad_get_pressed_key(Keypad* keypad); // Returns the pressed key (0-F) or -1 if none
+int keypad_get_released_key(Keypad* keypad); // Returns a key once pressed and released, or -1
 
-#endif // KEYBOARD_H
\ No newline at end of file
+#endif // KEYBOARD_H
@@ -4,9 +4,39 @@
 #include "emu8.h"
 #include "cpu.h"
 #include "keyboard.h"
+#include "pacer.h"
 
 #define DEFAULT_SCALE 10
 #define TARGET_FPS 60
+#define DEFAULT_CYCLES_PER_FRAME 10
+#define MAX_CYCLES_PER_FRAME 1000 // Keeps steps * cycles well inside an int
+#define STARTUP_PHASES 6 // options/state, load rom, sdl init, gpu resources, input, first frame
+
+typedef struct {
+    Uint64 start;                       // Entry to main()
+    Uint64 last;                        // End of the previous phase
+    const char* names[STARTUP_PHASES];
+    Uint64 durations[STARTUP_PHASES];   // Nanoseconds
+    int count;
+} StartupProfile;
+
+static void startup_mark(StartupProfile* profile, const char* phase) {
+    Uint64 now = pacer_now_ns();
+    if (profile->count < STARTUP_PHASES) {
+        profile->names[profile->count] = phase;
+        profile->durations[profile->count] = now - profile->last;
+        profile->count++;
+    }
+    profile->last = now;
+}
+
+static void startup_report(const StartupProfile* profile) {
+    printf("[%s] Startup profile:\n", __TIME__);
+    for (int i = 0; i < profile->count; i++) {
+        printf("  %-16s %8.3f ms\n", profile->names[i], profile->durations[i] / 1e6);
+    }
+    printf("  %-16s %8.3f ms\n", "time to frame", (profile->last - profile->start) / 1e6);
+}
 
 void render_display(Emu8* emu8) {
     void* pixels;
@@ -33,15 +63,30 @@ void render_display(Emu8* emu8) {
 }
 
 int main(int argc, char* argv[]) {
+    StartupProfile profile = {0};
+    profile.start = profile.last = pacer_now_ns();
+
     if (argc < 2) {
-        printf("Usage: %s <rom_file> [-s scale] [-f]\n", argv[0]);
+        printf("Usage: %s <rom_file> [-s scale] [-f] [-p mode] [-c cycles] [-k keys] [--frame-stats] [--input-latency] [--startup-profile]\n", argv[0]);
         printf("  -s scale: Set window scale (default %d, e.g., -s 15 for 15x)\n", DEFAULT_SCALE);
         printf("  -f: Enable full-screen mode\n");
+        printf("  -p mode: Frame pacing, 'emulated' (default, exact %d Hz) or 'display' (vsync)\n", TARGET_FPS);
+        printf("  -c cycles: Instructions per 1/60 s (default %d, max %d)\n", DEFAULT_CYCLES_PER_FRAME, MAX_CYCLES_PER_FRAME);
+        printf("  -k keys: Host keys for CHIP-8 keys 0-F (default x123qweasdzc4rfv)\n");
+        printf("  --frame-stats: Print frame time percentiles on exit\n");
+        printf("  --input-latency: Print key press to present latency percentiles on exit\n");
+        printf("  --startup-profile: Print time spent in each startup phase up to the first frame\n");
         return 1;
     }
 
     int scale = DEFAULT_SCALE;
     int fullscreen = 0;
+    PacerMode pacer_mode = PACER_MODE_EMULATED;
+    int frame_stats = 0;
+    int input_latency = 0;
+    int startup_profile = 0;
+    int cycles_per_frame = DEFAULT_CYCLES_PER_FRAME;
+    const char* keymap = NULL;
     const char* rom_file = argv[1];
 
     for (int i = 2; i < argc; i++) {
@@ -50,6 +95,28 @@ int main(int argc, char* argv[]) {
             if (scale < 1) scale = DEFAULT_SCALE;
         } else if (strcmp(argv[i], "-f") == 0) {
             fullscreen = 1;
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "display") == 0) {
+                pacer_mode = PACER_MODE_DISPLAY;
+            } else if (strcmp(mode, "emulated") == 0) {
+                pacer_mode = PACER_MODE_EMULATED;
+            } else {
+                fprintf(stderr, "[%s] Unknown pacing mode: %s\n", __TIME__, mode);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            cycles_per_frame = atoi(argv[++i]);
+            if (cycles_per_frame < 1) cycles_per_frame = DEFAULT_CYCLES_PER_FRAME;
+            if (cycles_per_frame > MAX_CYCLES_PER_FRAME) cycles_per_frame = MAX_CYCLES_PER_FRAME;
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            keymap = argv[++i];
+        } else if (strcmp(argv[i], "--frame-stats") == 0) {
+            frame_stats = 1;
+        } else if (strcmp(argv[i], "--input-latency") == 0) {
+            input_latency = 1;
+        } else if (strcmp(argv[i], "--startup-profile") == 0) {
+            startup_profile = 1;
         }
     }
 
@@ -57,19 +124,48 @@ int main(int argc, char* argv[]) {
     Emu8 emu8;
     init_emu8(&emu8);
 
-    cleanup_emu8(&emu8); // Reset SDL state
-    create_window_and_renderer(&emu8, scale, fullscreen);
+    if (keymap && keypad_set_keymap(&emu8.keypad, keymap) < 0) {
+        fprintf(stderr, "[%s] Invalid key layout: %s (need %d distinct keys)\n", __TIME__, keymap, KEYPAD_SIZE);
+        return 1;
+    }
+    startup_mark(&profile, "options/state");
 
+    // A bad ROM fails before any window shows up
     load_rom(&emu8, rom_file);
+    startup_mark(&profile, "load rom");
+
+    init_sdl();
+    startup_mark(&profile, "sdl init");
+
+    int vsync = create_window_and_renderer(&emu8, scale, fullscreen, pacer_mode == PACER_MODE_DISPLAY);
+    if (pacer_mode == PACER_MODE_DISPLAY && !vsync) {
+        fprintf(stderr, "[%s] Renderer did not grant vsync, falling back to emulated pacing\n", __TIME__);
+        pacer_mode = PACER_MODE_EMULATED;
+    }
+    startup_mark(&profile, "gpu resources");
+
+    keypad_attach(&emu8.keypad);
+    startup_mark(&profile, "input");
 
     int running = 1;
     SDL_Event event;
 
-    const Uint32 frame_delay = 1000 / TARGET_FPS;
-    Uint32 frame_start;
+    Pacer pacer;
+    pacer_init(&pacer, pacer_mode, TARGET_FPS);
+    if (pacer_mode == PACER_MODE_DISPLAY) {
+        SDL_DisplayMode display_mode;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(emu8.window), &display_mode) == 0) {
+            pacer_set_display_rate(&pacer, display_mode.refresh_rate);
+        }
+    }
+    TimingStats latency_probe = {0};
+
+    // Each frame's instructions replay the host interval since the previous batch,
+    // so a key event lands on the instruction matching its arrival time.
+    Uint64 batch_start = pacer_now_ns() - pacer.period;
 
     while (running) {
-        frame_start = SDL_GetTicks();
+        pacer_begin_frame(&pacer);
 
         while (SDL_PollEvent(&event)) {
             switch (event.type) {
@@ -77,8 +173,8 @@ int main(int argc, char* argv[]) {
                     running = 0;
                     break;
                 case SDL_KEYDOWN:
-                case SDL_KEYUP:
-                    keypad_handle_event(&emu8.keypad, &event, &running);
+                    // Keypad state arrives through the keypad's event watch
+                    if (event.key.keysym.sym == SDLK_ESCAPE) running = 0;
                     break;
                 case SDL_WINDOWEVENT:
                     if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
@@ -88,18 +184,41 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        emulate_cycle(&emu8);
-        disassemble_log(&emu8);
-        update_timers(&emu8);
+        // One step of instructions and timers per elapsed 1/60 s, whatever the display rate
+        int steps = pacer_emulated_steps(&pacer);
+        if (steps > 0) {
+            Uint64 batch_end = pacer_now_ns();
+            Uint64 batch_length = batch_end - batch_start;
+            int batch_cycles = steps * cycles_per_frame;
+            for (int i = 0; i < batch_cycles; i++) {
+                keypad_apply_events(&emu8.keypad, batch_start + batch_length * (i + 1) / batch_cycles);
+                emulate_cycle(&emu8);
+                if ((i + 1) % cycles_per_frame == 0) update_timers(&emu8);
+            }
+            batch_start = batch_end;
+            disassemble_log(&emu8);
+        }
 
         render_display(&emu8);
+        keypad_record_latency(&emu8.keypad, &latency_probe, pacer_now_ns());
 
-        Uint32 frame_time = SDL_GetTicks() - frame_start;
-        if (frame_time < frame_delay) {
-            SDL_Delay(frame_delay - frame_time);
+        if (startup_profile) {
+            startup_mark(&profile, "first frame");
+            startup_report(&profile);
+            startup_profile = 0;
         }
+
+        pacer_end_frame(&pacer);
+    }
+
+    if (frame_stats) {
+        timing_stats_report(&pacer.frame_times, "Frame time");
+    }
+    if (input_latency) {
+        timing_stats_report(&latency_probe, "Input latency");
     }
 
+    keypad_detach(&emu8.keypad);
     cleanup_emu8(&emu8);
     return 0;
 }
\ No newline at end of file
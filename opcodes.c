@@ -109,13 +109,13 @@ void execute_opcode(Emu8* emu8, unsigned short opcode) {
                     emu8->V[(opcode & 0x0F00) >> 8] = emu8->delay_timer;
                     break;
 
-                case 0x0A: // LD Vx, K (Wait for keypress)
+                case 0x0A: // LD Vx, K (Wait for key press and release)
                     {
-                        int key = keypad_get_pressed_key(&emu8->keypad);
+                        int key = keypad_get_released_key(&emu8->keypad);
                         if (key >= 0) {
                             emu8->V[(opcode & 0x0F00) >> 8] = (unsigned char)key;
                         } else {
-                            emu8->pc -= 2; // Stay on this instruction until a key is pressed
+                            emu8->pc -= 2; // Stay on this instruction until a key is released
                         }
                     }
                     break;
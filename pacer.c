@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pacer.h"
+
+#define NS_PER_SEC 1000000000ULL
+#define NS_PER_MS 1000000ULL
+
+// Monotonic clock in nanoseconds, split to avoid overflowing counter * 1e9
+Uint64 pacer_now_ns(void) {
+    static Uint64 frequency = 0;
+    if (frequency == 0) frequency = SDL_GetPerformanceFrequency();
+
+    Uint64 counter = SDL_GetPerformanceCounter();
+    return (counter / frequency) * NS_PER_SEC +
+           (counter % frequency) * NS_PER_SEC / frequency;
+}
+
+void pacer_init(Pacer* pacer, PacerMode mode, Uint32 hz) {
+    memset(pacer, 0, sizeof(Pacer));
+    pacer->mode = mode;
+    pacer->hz = hz;
+    pacer->period = NS_PER_SEC / hz;
+    pacer->period_remainder = NS_PER_SEC % hz;
+    pacer->present_period = pacer->period;
+    pacer->present_budget = PACER_PRESENT_BUDGET_NS;
+}
+
+// Keep at least a quarter of every refresh for sleeping and pumping
+static Uint64 clamp_present_budget(const Pacer* pacer, Uint64 budget) {
+    Uint64 max_budget = pacer->present_period * 3 / 4;
+    return budget > max_budget ? max_budget : budget;
+}
+
+void pacer_set_display_rate(Pacer* pacer, int refresh_hz) {
+    if (refresh_hz > 0) pacer->present_period = NS_PER_SEC / refresh_hz;
+    pacer->present_budget = clamp_present_budget(pacer, pacer->present_budget);
+}
+
+// Sleep in 1 ms steps and pump in between so event watches stamp input as it arrives.
+// May overshoot `until` by one sleep; callers keep a margin for that.
+static Uint64 sleep_and_pump(Uint64 now, Uint64 until) {
+    while (now < until) {
+        SDL_Delay(1);
+        SDL_PumpEvents();
+        now = pacer_now_ns();
+    }
+    return now;
+}
+
+void pacer_begin_frame(Pacer* pacer) {
+    Uint64 now = pacer_now_ns();
+    if (pacer->frame_start) {
+        timing_stats_record(&pacer->frame_times, now - pacer->frame_start);
+    }
+    pacer->frame_start = now;
+    if (pacer->deadline == 0) pacer->deadline = now;
+
+    // A blocking present cannot pump, so wait out most of the refresh here instead
+    // and leave only the budget for emulation, render and the present itself.
+    if (pacer->mode == PACER_MODE_DISPLAY && pacer->last_present) {
+        Uint64 vblank = pacer->last_present + pacer->present_period;
+        if (vblank > now + pacer->present_budget) {
+            sleep_and_pump(now, vblank - pacer->present_budget);
+        }
+    }
+}
+
+// Advance the absolute deadline by exactly one period so rounding never accumulates
+static void advance_deadline(Pacer* pacer) {
+    pacer->deadline += pacer->period;
+    pacer->drift += pacer->period_remainder;
+    if (pacer->drift >= pacer->hz) {
+        pacer->drift -= pacer->hz;
+        pacer->deadline++;
+    }
+}
+
+int pacer_emulated_steps(Pacer* pacer) {
+    // The deadline already spaces frames exactly one period apart
+    if (pacer->mode == PACER_MODE_EMULATED) return 1;
+
+    // Display rate is unrelated to the emulated clock, so step by elapsed time.
+    // Start half a step in so present jitter never straddles a step boundary.
+    Uint64 now = pacer_now_ns();
+    if (pacer->step_time == 0) {
+        pacer->step_time = now;
+        pacer->step_accumulator = NS_PER_SEC + NS_PER_SEC / 2;
+    }
+    pacer->step_accumulator += (now - pacer->step_time) * pacer->hz;
+    pacer->step_time = now;
+
+    int steps = (int)(pacer->step_accumulator / NS_PER_SEC);
+    pacer->step_accumulator %= NS_PER_SEC;
+    if (steps > PACER_MAX_STEPS) steps = PACER_MAX_STEPS; // Stalled, drop the backlog
+    return steps;
+}
+
+void pacer_end_frame(Pacer* pacer) {
+    if (pacer->mode == PACER_MODE_DISPLAY) {
+        // Present already blocked on vsync. Missing a vblank means the budget was
+        // too tight, so widen it; a run of on-time presents halves it back down
+        // so a single hitch does not disable pumping for good.
+        Uint64 now = pacer_now_ns();
+        if (pacer->last_present && now - pacer->last_present > pacer->present_period * 3 / 2) {
+            pacer->present_budget = clamp_present_budget(pacer, pacer->present_budget * 2);
+            pacer->on_time_presents = 0;
+        } else if (++pacer->on_time_presents >= PACER_BUDGET_DECAY_PRESENTS) {
+            Uint64 budget = pacer->present_budget / 2;
+            if (budget < PACER_PRESENT_BUDGET_NS) budget = PACER_PRESENT_BUDGET_NS;
+            pacer->present_budget = clamp_present_budget(pacer, budget);
+            pacer->on_time_presents = 0;
+        }
+        pacer->last_present = now;
+        return;
+    }
+
+    advance_deadline(pacer);
+    Uint64 now = pacer_now_ns();
+
+    // More than a frame behind: resync instead of bursting frames to catch up
+    if (now > pacer->deadline + pacer->period) {
+        pacer->deadline = now;
+        return;
+    }
+
+    // Coarse sleep while the OS scheduler can be trusted, then spin the rest
+    now = sleep_and_pump(now, pacer->deadline - PACER_SPIN_MARGIN_NS);
+    while (now < pacer->deadline) {
+        now = pacer_now_ns();
+    }
+}
+
+void timing_stats_record(TimingStats* stats, Uint64 sample) {
+    stats->samples[stats->count % PACER_STATS_SAMPLES] = sample;
+    stats->count++;
+}
+
+static int compare_samples(const void* a, const void* b) {
+    Uint64 lhs = *(const Uint64*)a;
+    Uint64 rhs = *(const Uint64*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+void timing_stats_report(const TimingStats* stats, const char* label) {
+    size_t n = stats->count < PACER_STATS_SAMPLES ? stats->count : PACER_STATS_SAMPLES;
+    if (n == 0) {
+        printf("[%s] %s: no samples\n", __TIME__, label);
+        return;
+    }
+
+    static Uint64 sorted[PACER_STATS_SAMPLES];
+    memcpy(sorted, stats->samples, n * sizeof(Uint64));
+    qsort(sorted, n, sizeof(Uint64), compare_samples);
+
+    printf("[%s] %s (last %zu of %zu): p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           __TIME__, label, n, stats->count,
+           sorted[n / 2] / (double)NS_PER_MS,
+           sorted[(n * 99) / 100] / (double)NS_PER_MS,
+           sorted[n - 1] / (double)NS_PER_MS);
+}
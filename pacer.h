@@ -0,0 +1,49 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <SDL2/SDL.h>
+
+#define PACER_STATS_SAMPLES 4096          // Ring of recent samples kept for percentiles
+#define PACER_SPIN_MARGIN_NS 2000000ULL   // Busy-wait the last 2 ms before a deadline
+#define PACER_MAX_STEPS 4                 // Emulated steps per frame before time is dropped
+#define PACER_PRESENT_BUDGET_NS 4000000ULL // Display mode: wake 4 ms before the predicted vblank
+#define PACER_BUDGET_DECAY_PRESENTS 60     // On-time presents in a row before a widened budget shrinks
+
+typedef enum {
+    PACER_MODE_DISPLAY,  // Renderer presents with vsync, the display sets the rate
+    PACER_MODE_EMULATED  // Sleep/spin to the emulated clock, vsync off
+} PacerMode;
+
+typedef struct {
+    Uint64 samples[PACER_STATS_SAMPLES]; // Nanoseconds, oldest overwritten first
+    size_t count;                        // Total samples recorded
+} TimingStats;
+
+typedef struct {
+    PacerMode mode;
+    Uint32 hz;                // Target rate in frames per second
+    Uint64 period;            // Whole nanoseconds per frame (1e9 / hz)
+    Uint32 period_remainder;  // Leftover of 1e9 / hz, spread over frames
+    Uint32 drift;             // Accumulated remainder, one extra ns once it reaches hz
+    Uint64 deadline;          // Absolute end of the current frame
+    Uint64 frame_start;       // Start of the current frame
+    Uint64 step_time;         // Host time last folded into the step accumulator
+    Uint64 step_accumulator;  // Elapsed ns scaled by hz, so one step is exactly 1e9
+    Uint64 present_period;    // Display mode: refresh interval in nanoseconds
+    Uint64 present_budget;    // Display mode: time left for emulation and render before vblank
+    Uint64 last_present;      // Display mode: when the previous present returned
+    int on_time_presents;     // Display mode: presents in a row that hit their vblank
+    TimingStats frame_times;  // Start-to-start frame intervals
+} Pacer;
+
+Uint64 pacer_now_ns(void);
+void pacer_init(Pacer* pacer, PacerMode mode, Uint32 hz);
+void pacer_set_display_rate(Pacer* pacer, int refresh_hz);
+void pacer_begin_frame(Pacer* pacer);
+void pacer_end_frame(Pacer* pacer);
+int pacer_emulated_steps(Pacer* pacer); // Elapsed 1/hz steps of emulated time this frame
+
+void timing_stats_record(TimingStats* stats, Uint64 sample);
+void timing_stats_report(const TimingStats* stats, const char* label);
+
+#endif // PACER_H